@@ -1,3 +1,4 @@
+#include "rcu_stats.h"  // RcuStats
 #include "sync_modes.h" // SyncMode enum
 #include "utils.h"      // utils
 
@@ -10,13 +11,21 @@
 #include "operations/struct_abc.h"
 #elif defined(OP_ATOMIC_VEC)
 #include "operations/atomic_vector.h"
+#elif defined(OP_MULTI_SLOT)
+#include "operations/multi_slot.h"
+#elif defined(OP_BLOB)
+#include "operations/blob.h"
 #else
 #error("No operation implementations available!")
 #endif
 
+#include <algorithm> // std::max, std::nth_element
+#include <fstream>   // std::ofstream
 #include <iomanip>   // std::setprecision
 #include <iostream>  // cout
 #include <pthread.h> // pthread, mutex
+#include <random>    // std::mt19937_64, std::exponential_distribution
+#include <sstream>   // std::ostringstream
 #include <unistd.h>  // usleep
 #include <vector>    // std::vector
 
@@ -30,17 +39,68 @@ bool run_benchmark = false;  // used as a barrier flag to start all threads at o
 bool readers_running = true; // used to keep writers running while readers reading
 int write_freq_us = 10;      // write frequency in microseconds (us) (1000x ns)
 
-struct ThreadData
+enum Arrivals : uint8_t
+{
+    FIXED = 0, // evenly spaced writes
+    POISSON,   // exponentially distributed inter-arrival times
+};
+double write_rate = 0;                     // target writes/sec across all writers (0 => closed loop w/ write_freq_us)
+Arrivals write_arrivals = Arrivals::FIXED; // how writes are scheduled in the open loop
+const cycles_t SPIN_NS = 20000;            // spin (rather than sleep) for the last 20us before a scheduled write
+
+double read_pct = -1;   // mixed mode: % of every thread's ops that are reads (< 0 => dedicated readers & writers)
+size_t duration_ms = 0; // run for this long instead of RD_OUTER_LOOP outer loops (0 => use the loop count)
+cycles_t end_ns = 0;    // when a duration-based run ends (set right before the threads start)
+
+inline bool using_mixed()
+{
+    return read_pct >= 0;
+}
+
+inline bool keep_looping(size_t outer_iter) // whether to run another outer loop
+{
+    return (duration_ms > 0) ? (get_cycles() < end_ns) : (outer_iter < RD_OUTER_LOOP);
+}
+
+inline bool keep_writing() // writers run for the duration (if any) or for as long as the readers do
+{
+    return (duration_ms > 0) ? (get_cycles() < end_ns) : readers_running;
+}
+
+const size_t DEADLINE_CHECK_OPS = 1024; // (mixed mode) check the duration deadline at least every this many ops
+
+struct alignas(64) ThreadData // own cache line(s) so the sampled counters don't false-share across threads
 {
     pthread_t thread;
     size_t id = 0;
-    size_t num_writes = 0;
-    size_t num_reads = 0;
-    cycles_t cycles = 0;
+    SampledCounter num_writes;
+    SampledCounter num_reads;
+    SampledCounter cycles;
+    SampledCounter write_cycles;      // (mixed mode) portion of cycles spent in writes
+    std::atomic<bool> running{false}; // (readers & mixed) currently in the read loops
+    cycles_t latency = 0;             // sum of (completion - scheduled) over all writes
+    cycles_t max_latency = 0;         // worst (completion - scheduled) of any write
+    size_t unissued = 0;              // (open loop) writes already due when the run ended but never issued
 };
 
 std::vector<ThreadData> readers;
 std::vector<ThreadData> writers;
+std::vector<ThreadData> mixers; // threads doing both reads and writes (mixed mode)
+
+struct Sample // snapshot of all the threads' counters
+{
+    cycles_t t_ns = 0;
+    size_t reads = 0;
+    size_t writes = 0;
+    cycles_t write_cycles = 0; // writers' cycles + mixed threads' write cycles
+    size_t reading = 0;        // how many reader (or mixed) threads are in their read loops
+};
+
+size_t sample_ms = 10;      // sampler interval (0 => no sampler, report from the totals)
+double steady_tol = 0.1;    // max relative deviation from the median throughput to count as steady state
+std::string timeseries_csv; // where to write the sampled time series (empty => nowhere)
+bool sampling = true;       // used to keep the sampler running while any thread is
+std::vector<Sample> samples;
 
 void *write_behavior(void *args)
 {
@@ -59,14 +119,49 @@ void *write_behavior(void *args)
         rcu_register_thread();
 
     auto &writer = writers[id];
-    while (readers_running)
+    const bool open_loop = (write_rate > 0);
+    const double period_ns = open_loop ? 1e9 * num_writers / write_rate : 0; // per-writer inter-arrival time
+    std::mt19937_64 gen(id + 1);
+    std::exponential_distribution<double> inter_arrival(open_loop ? 1.0 / period_ns : 1.0);
+    auto next_arrival = [&]() { return (write_arrivals == Arrivals::POISSON) ? inter_arrival(gen) : period_ns; };
+    double scheduled_ns = get_cycles(); // when the next write is due (open loop only)
+    while (keep_writing())
     {
+        if (open_loop)
+        {
+            // the schedule never waits on the writes, so slow writes queue up rather than lowering the load
+            scheduled_ns += next_arrival();
+            if (using_rcu())
+                rcu_thread_offline(); // don't hold up everyone else's grace periods while sleeping
+            wait_until(static_cast<cycles_t>(scheduled_ns), SPIN_NS);
+            if (using_rcu())
+                rcu_thread_online();
+        }
         auto t0_ns = get_cycles();
         write_op();
         auto t1_ns = get_cycles();
         writer.cycles += (t1_ns - t0_ns); // don't account the usleep usec
         writer.num_writes++;              // number of writes this thread has committed
-        usleep(write_freq_us);            // sleep for this many microseconds
+
+        // measure from when the write was *due* (not issued) to avoid coordinated omission
+        const cycles_t start_ns = open_loop ? static_cast<cycles_t>(scheduled_ns) : t0_ns;
+        const cycles_t latency = (t1_ns > start_ns) ? (t1_ns - start_ns) : 0;
+        writer.latency += latency;
+        writer.max_latency = std::max(writer.max_latency, latency);
+        if (!open_loop)
+        {
+            if (using_rcu())
+                rcu_thread_offline(); // don't hold up everyone else's grace periods while sleeping
+            usleep(write_freq_us);    // sleep for this many microseconds
+            if (using_rcu())
+                rcu_thread_online();
+        }
+    }
+    if (open_loop) // the backlog of a mode that couldn't keep up with the rate is dropped, but still counted
+    {
+        const cycles_t stop_ns = get_cycles();
+        while ((scheduled_ns += next_arrival()) <= stop_ns)
+            writer.unissued++;
     }
 
     if (using_rcu())
@@ -94,8 +189,9 @@ void *read_behavior(void *args)
         rcu_register_thread();
 
     auto &reader = readers[id];
+    reader.running.store(true, std::memory_order_relaxed);
 
-    for (size_t i = 0; i < RD_OUTER_LOOP; i++)
+    for (size_t i = 0; keep_looping(i); i++)
     {
         for (size_t j = 0; j < RD_INNER_LOOP; j++)
         {
@@ -104,6 +200,7 @@ void *read_behavior(void *args)
         }
         _rcu_quiescent_state();
     }
+    reader.running.store(false, std::memory_order_relaxed);
     auto t1_ns = get_cycles();
     reader.cycles = (t1_ns - t0_ns);
 
@@ -114,6 +211,183 @@ void *read_behavior(void *args)
     return NULL;
 }
 
+void *mixed_behavior(void *args)
+{
+    size_t id = *(size_t *)args;
+    if (id >= mixers.size())
+    {
+        std::cerr << "Thread (mixed) out of bounds! Id: " << id << std::endl;
+        exit(1);
+    }
+    cout_lock("Begin mixed thread " << id);
+
+    while (!run_benchmark) // wait until run_benchmark == true to start all threads at once
+        usleep(1);
+
+    auto t0_ns = get_cycles();
+    if (using_rcu())
+        rcu_register_thread();
+
+    auto &mixer = mixers[id];
+    // compare against the top 32 bits of a random draw, so 100% reads is 2^32 (always taken)
+    const uint64_t read_threshold = static_cast<uint64_t>(read_pct / 100.0 * (1ULL << 32));
+    mixer.running.store(true, std::memory_order_relaxed);
+
+    for (size_t i = 0; keep_looping(i); i++)
+    {
+        for (size_t j = 0; j < RD_INNER_LOOP; j++)
+        {
+            // don't wait out a whole inner loop (of possibly many grace periods) past the deadline
+            if (duration_ms > 0 && (j % DEADLINE_CHECK_OPS) == 0 && get_cycles() >= end_ns)
+                break;
+            if ((fast_rand() >> 32) < read_threshold)
+            {
+                read_op();
+                mixer.num_reads++;
+            }
+            else
+            {
+                auto w0_ns = get_cycles(); // only time the (rare, slow) writes individually
+                write_op();
+                auto w1_ns = get_cycles();
+                mixer.write_cycles += (w1_ns - w0_ns);
+                mixer.num_writes++;
+                if (duration_ms > 0 && w1_ns >= end_ns)
+                    break; // already have the time, so check the deadline after every write
+            }
+        }
+        _rcu_quiescent_state();
+    }
+    mixer.running.store(false, std::memory_order_relaxed);
+    auto t1_ns = get_cycles();
+    mixer.cycles = (t1_ns - t0_ns);
+
+    if (using_rcu())
+        rcu_unregister_thread();
+
+    cout_lock("Finish m(" << id << ") @ " << mixer.cycles / 1e9 << "s w/ " << mixer.num_reads << " reads & "
+                          << mixer.num_writes << " writes");
+    return NULL;
+}
+
+Sample take_sample()
+{
+    Sample sample;
+    sample.t_ns = get_cycles();
+    for (auto &reader : readers)
+    {
+        sample.reads += reader.num_reads;
+        sample.reading += reader.running.load(std::memory_order_relaxed);
+    }
+    for (auto &writer : writers)
+    {
+        sample.writes += writer.num_writes;
+        sample.write_cycles += writer.cycles;
+    }
+    for (auto &mixer : mixers)
+    {
+        sample.reads += mixer.num_reads;
+        sample.writes += mixer.num_writes;
+        sample.write_cycles += mixer.write_cycles;
+        sample.reading += mixer.running.load(std::memory_order_relaxed);
+    }
+    return sample;
+}
+
+void *sample_behavior(void *args)
+{
+    while (!run_benchmark) // wait until run_benchmark == true to start with all the other threads
+        usleep(1);
+
+    const cycles_t period_ns = sample_ms * 1000000ULL;
+    cycles_t next_ns = get_cycles();
+    while (sampling)
+    {
+        samples.push_back(take_sample());
+        next_ns += period_ns;
+        wait_until(next_ns, 0); // absolute deadlines so the interval doesn't drift
+    }
+    samples.push_back(take_sample()); // the very end
+    return NULL;
+}
+
+inline double ops_per_sec(const Sample &s0, const Sample &s1)
+{
+    return ((s1.reads - s0.reads) + (s1.writes - s0.writes)) / ((s1.t_ns - s0.t_ns) / 1e9);
+}
+
+struct SteadyWindow
+{
+    size_t begin = 0; // sample the window starts at
+    size_t end = 0;   // sample the window ends at (== begin => no steady state)
+    inline bool found() const
+    {
+        return end > begin;
+    }
+};
+
+// the longest run of sample intervals (with every reader/mixed thread running) whose throughput stays within
+// steady_tol of the median, ie. without the warm-up nor the tail where some readers have already finished
+SteadyWindow find_steady_window(size_t num_reading)
+{
+    const size_t MIN_INTERVALS = 3;
+    SteadyWindow window;
+    if (samples.size() < MIN_INTERVALS + 1)
+        return window;
+
+    std::vector<bool> all_running(samples.size() - 1);
+    std::vector<double> throughputs;
+    for (size_t i = 0; i + 1 < samples.size(); i++)
+    {
+        all_running[i] = (samples[i].reading == num_reading && samples[i + 1].reading == num_reading);
+        if (all_running[i])
+            throughputs.push_back(ops_per_sec(samples[i], samples[i + 1]));
+    }
+    if (throughputs.size() < MIN_INTERVALS)
+        return window;
+    std::nth_element(throughputs.begin(), throughputs.begin() + throughputs.size() / 2, throughputs.end());
+    const double median = throughputs[throughputs.size() / 2];
+
+    size_t run_begin = 0;
+    for (size_t i = 0; i + 1 < samples.size(); i++)
+    {
+        const double deviation = std::abs(ops_per_sec(samples[i], samples[i + 1]) - median);
+        if (!all_running[i] || deviation > steady_tol * median)
+        {
+            run_begin = i + 1; // restart the run after this interval
+            continue;
+        }
+        if (i + 1 - run_begin > window.end - window.begin)
+        {
+            window.begin = run_begin;
+            window.end = i + 1;
+        }
+    }
+    if (window.end - window.begin < MIN_INTERVALS)
+        window = SteadyWindow{};
+    return window;
+}
+
+void write_timeseries(const SteadyWindow &window)
+{
+    std::ofstream csv(timeseries_csv);
+    if (!csv)
+    {
+        std::cerr << "Unable to write time series to \"" << timeseries_csv << "\"" << std::endl;
+        return;
+    }
+    csv << "t_ms,reads_per_sec,writes_per_sec,reading_threads,steady" << std::endl;
+    for (size_t i = 0; i + 1 < samples.size(); i++)
+    {
+        const Sample &s0 = samples[i];
+        const Sample &s1 = samples[i + 1];
+        const double dt_s = (s1.t_ns - s0.t_ns) / 1e9;
+        csv << (s1.t_ns - samples[0].t_ns) / 1e6 << "," << (s1.reads - s0.reads) / dt_s << ","
+            << (s1.writes - s0.writes) / dt_s << "," << s1.reading << ","
+            << (i >= window.begin && i < window.end) << std::endl;
+    }
+}
+
 enum CMD_PARAMS : uint8_t
 {
     _BINARY = 0, // first cmd is the binary name always
@@ -126,13 +400,71 @@ enum CMD_PARAMS : uint8_t
     _SIZE // meta "param" for how many cmd params we have
 };
 
+bool parse_flag(const std::string &arg)
+{
+    std::string value;
+    if (match_flag(arg, "write-rate", value))
+        write_rate = std::atof(value.c_str());
+    else if (match_flag(arg, "arrivals", value))
+    {
+        if (value == "fixed")
+            write_arrivals = Arrivals::FIXED;
+        else if (value == "poisson")
+            write_arrivals = Arrivals::POISSON;
+        else
+            throw std::runtime_error("unable to interpret arrivals \"" + value + "\"");
+    }
+    else if (match_flag(arg, "read-pct", value))
+        read_pct = std::min(std::max(std::atof(value.c_str()), 0.0), 100.0);
+    else if (match_flag(arg, "duration-ms", value))
+        duration_ms = std::atoi(value.c_str());
+    else if (match_flag(arg, "sample-ms", value))
+        sample_ms = std::atoi(value.c_str());
+    else if (match_flag(arg, "steady-tol", value))
+        steady_tol = std::atof(value.c_str());
+    else if (match_flag(arg, "timeseries", value))
+        timeseries_csv = value;
+    else
+        return parse_op_flag(arg); // maybe it is specific to this op
+    return true;
+}
+
+// RCU grace period & reclamation stats (+ peak memory) as extra columns: grace period ns per write (amortized when
+// batched), copy & publish ns per write, grace periods, max & avg old versions alive, peak RSS (KB)
+std::string rcu_stats_columns()
+{
+    const float writes = std::max(rcu_stats.publishes, static_cast<size_t>(1));
+    std::ostringstream oss;
+    oss << rcu_stats.grace_cycles / writes << " " << rcu_stats.publish_cycles / writes << " "
+        << rcu_stats.grace_periods << " " << rcu_stats.max_old_versions << " " << rcu_stats.old_versions_sum / writes
+        << " " << peak_rss_kb();
+    return oss.str();
+}
+
+void print_rcu_stats()
+{
+    const float writes = std::max(rcu_stats.publishes, static_cast<size_t>(1));
+    const float grace_periods = std::max(rcu_stats.grace_periods, static_cast<size_t>(1));
+    if (using_rcu())
+        std::cout << std::fixed << std::setprecision(3) << "RCU -- Grace periods: " << rcu_stats.grace_periods
+                  << " for " << rcu_stats.publishes << " writes | Avg grace period: "
+                  << rcu_stats.grace_cycles / grace_periods << "ns (" << rcu_stats.grace_cycles / writes
+                  << "ns per write) | Avg copy & publish: " << rcu_stats.publish_cycles / writes
+                  << "ns | Old versions alive (max/avg): " << rcu_stats.max_old_versions << "/"
+                  << rcu_stats.old_versions_sum / writes << std::endl;
+    std::cout << "Peak RSS: " << peak_rss_kb() << "KB" << std::endl;
+}
+
 int main(int argc, char **argv)
 {
     if (argc < CMD_PARAMS::_SIZE) // required params
     {
         std::cout << "Usage: {num_readers} {num_writers} ";
         std::cout << "[\"RCU\"|\"RWLOCK\"|\"LOCK\"|\"ATOMIC\"|\"RACE\"] ";
-        std::cout << "{RD_OUTER_LOOP} {RD_INNER_LOOP} [optional: verbose?]" << std::endl;
+        std::cout << "{RD_OUTER_LOOP} {RD_INNER_LOOP} [optional: verbose?] ";
+        std::cout << "[--write-rate={writes/sec}] [--arrivals=fixed|poisson] (not with --read-pct) ";
+        std::cout << "[--read-pct={0-100}] [--duration-ms={ms}] ";
+        std::cout << "[--sample-ms={ms}] [--steady-tol={frac}] [--timeseries={csv}] [op-specific options]" << std::endl;
         exit(1);
     }
     num_readers = std::atoi(argv[CMD_PARAMS::NUM_READERS]);
@@ -141,30 +473,73 @@ int main(int argc, char **argv)
     RD_OUTER_LOOP = std::atoi(argv[CMD_PARAMS::LOOP_COUNT_OUTER]);
     RD_INNER_LOOP = std::atoi(argv[CMD_PARAMS::LOOP_COUNT_INNER]);
 
-    if (argc == CMD_PARAMS::_SIZE + 1)
-    { // optional param
-        verbose = false;
+    for (int i = CMD_PARAMS::_SIZE; i < argc; i++)
+    { // optional params
+        const std::string arg{argv[i]};
+        if (arg.compare(0, 2, "--") != 0)
+            verbose = false; // any other trailing param (ie. "quiet") disables verbose
+        else if (!parse_flag(arg))
+        {
+            std::cerr << "Unknown option \"" << arg << "\"" << std::endl;
+            exit(1);
+        }
+    }
+    if (using_mixed() && (write_rate > 0 || write_arrivals != Arrivals::FIXED))
+    { // mixed threads interleave their writes with reads, there is no open loop schedule to apply these to
+        std::cerr << "--write-rate & --arrivals only apply to dedicated writers, not with --read-pct" << std::endl;
+        exit(1);
     }
 
     if (verbose)
     {
-        std::cout << "Reader threads running " << RD_OUTER_LOOP << " outer loops of " << RD_INNER_LOOP << " reads"
-                  << std::endl;
-        std::cout << "Writer threads running with frequency of " << write_freq_us << "us writes" << std::endl;
-        std::cout << "Running with " << num_readers << " readers & " << num_writers << " writers" << std::endl;
+        if (duration_ms > 0)
+            std::cout << "Threads running for " << duration_ms << "ms in loops of " << RD_INNER_LOOP << " ops"
+                      << std::endl;
+        else
+            std::cout << "Reader threads running " << RD_OUTER_LOOP << " outer loops of " << RD_INNER_LOOP << " reads"
+                      << std::endl;
+        if (using_mixed())
+            std::cout << "Running with " << num_readers + num_writers << " mixed threads doing " << read_pct
+                      << "% reads" << std::endl;
+        else if (write_rate > 0)
+            std::cout << "Writer threads running open loop at " << write_rate << " writes/sec ("
+                      << (write_arrivals == Arrivals::POISSON ? "poisson" : "fixed") << " arrivals)" << std::endl;
+        else
+            std::cout << "Writer threads running with frequency of " << write_freq_us << "us writes" << std::endl;
+        if (!using_mixed())
+            std::cout << "Running with " << num_readers << " readers & " << num_writers << " writers" << std::endl;
         std::cout << "Synchronization method: " << SyncName(sync_method) << std::endl << std::endl;
     }
 
+    init_op(); // after all the op-specific options were parsed
+
     pthread_rwlock_init(&rwlock, NULL);
     pthread_mutex_init(&mutexlock, NULL);
     pthread_mutex_init(&stdout_lock, NULL);
 
+    // allocate mixed threads elements (these replace the dedicated readers & writers)
+    if (using_mixed())
+    {
+        const size_t num_mixers = num_readers + num_writers;
+        mixers = std::vector<ThreadData>(num_mixers);
+        for (size_t i = 0; i < num_mixers; i++)
+        {
+            size_t *args = new size_t(i);
+            if (pthread_create(&(mixers[i].thread), NULL, mixed_behavior, (void *)args) != 0)
+            {
+                std::cout << "Unable to create new mixed thread (" << i << ")" << std::endl;
+                exit(1);
+            }
+        }
+        num_readers = 0;
+        num_writers = 0;
+    }
+
     // allocate writer threads elements
-    writers.reserve(num_writers);
+    writers = std::vector<ThreadData>(num_writers);
     for (size_t i = 0; i < num_writers; i++)
     {
         size_t *args = new size_t(i);
-        writers.push_back(ThreadData());
         if (pthread_create(&(writers[i].thread), NULL, write_behavior, (void *)args) != 0)
         {
             std::cout << "Unable to create new writer thread (" << i << ")" << std::endl;
@@ -173,11 +548,10 @@ int main(int argc, char **argv)
     }
 
     // allocate reader threads elements
-    readers.reserve(num_readers);
+    readers = std::vector<ThreadData>(num_readers);
     for (size_t i = 0; i < num_readers; i++)
     {
         size_t *args = new size_t(i);
-        readers.push_back(ThreadData());
         if (pthread_create(&(readers[i].thread), NULL, read_behavior, (void *)args) != 0)
         {
             std::cout << "Unable to create new thread (" << i << ")" << std::endl;
@@ -185,33 +559,106 @@ int main(int argc, char **argv)
         }
     }
 
+    // sampler thread snapshots everyone's counters (never touching the hot loops)
+    pthread_t sampler;
+    if (sample_ms > 0 && pthread_create(&sampler, NULL, sample_behavior, NULL) != 0)
+    {
+        std::cout << "Unable to create sampler thread" << std::endl;
+        exit(1);
+    }
+
+    const cycles_t start_ns = get_cycles();
+    end_ns = start_ns + duration_ms * 1000000ULL;
     run_benchmark = true; // start all the threads at once!
     // let it run for a while ...
 
     // join readers
     cycles_t tot_read_cycles = 0;
+    size_t NUM_READS = 0;
     for (auto &reader : readers)
     {
         pthread_join(reader.thread, NULL);
         tot_read_cycles += reader.cycles;
+        NUM_READS += reader.num_reads;
     }
     readers_running = false; // stop the writers
 
     // join writers
     cycles_t tot_write_cycles = 0;
+    cycles_t tot_write_latency = 0;
+    cycles_t max_write_latency = 0;
     size_t NUM_WRITES = 0;
+    size_t NUM_UNISSUED = 0;
     for (auto &writer : writers)
     {
         pthread_join(writer.thread, NULL);
         tot_write_cycles += writer.cycles;
+        tot_write_latency += writer.latency;
+        max_write_latency = std::max(max_write_latency, writer.max_latency);
         NUM_WRITES += writer.num_writes;
+        NUM_UNISSUED += writer.unissued;
+    }
+    const float writes_per_sec = NUM_WRITES / ((get_cycles() - start_ns) / 1e9); // achieved (vs --write-rate)
+
+    // join mixed threads
+    cycles_t tot_mixed_cycles = 0;
+    cycles_t tot_mixed_write_cycles = 0;
+    cycles_t max_mixed_cycles = 0; // wall time of the mixed run
+    size_t NUM_MIXED_READS = 0;
+    size_t NUM_MIXED_WRITES = 0;
+    for (auto &mixer : mixers)
+    {
+        pthread_join(mixer.thread, NULL);
+        tot_mixed_cycles += mixer.cycles;
+        tot_mixed_write_cycles += mixer.write_cycles;
+        max_mixed_cycles = std::max(max_mixed_cycles, mixer.cycles.load());
+        NUM_MIXED_READS += mixer.num_reads;
+        NUM_MIXED_WRITES += mixer.num_writes;
     }
 
+    // join sampler
+    sampling = false;
+    if (sample_ms > 0)
+        pthread_join(sampler, NULL);
+    const size_t num_reading = readers.size() + mixers.size();
+    const SteadyWindow window = find_steady_window(num_reading);
+    if (!timeseries_csv.empty())
+        write_timeseries(window);
+
+    // all the per-op numbers come from the totals, unless there is a steady state window to use instead
+    float cycles_per_read = tot_read_cycles / static_cast<float>(NUM_READS);
+    float cycles_per_write = tot_write_cycles / static_cast<float>(NUM_WRITES);
+    float mixed_ops_per_sec = (NUM_MIXED_READS + NUM_MIXED_WRITES) / (max_mixed_cycles / 1e9); // over wall time
+    float mixed_cycles_per_read = (tot_mixed_cycles - tot_mixed_write_cycles) / static_cast<float>(NUM_MIXED_READS);
+    float mixed_cycles_per_write = tot_mixed_write_cycles / static_cast<float>(NUM_MIXED_WRITES);
+    if (window.found())
+    {
+        const Sample &s0 = samples[window.begin];
+        const Sample &s1 = samples[window.end];
+        const size_t reads = s1.reads - s0.reads;
+        const size_t writes = s1.writes - s0.writes;
+        const cycles_t write_cycles = s1.write_cycles - s0.write_cycles;
+        const cycles_t reading_cycles = num_reading * (s1.t_ns - s0.t_ns); // every reader ran the whole window
+        cycles_per_read = reading_cycles / static_cast<float>(reads);
+        mixed_cycles_per_read = (reading_cycles - write_cycles) / static_cast<float>(reads);
+        mixed_ops_per_sec = ops_per_sec(s0, s1);
+        if (writes > 0) // otherwise the window is too short to see a write, keep the totals
+        {
+            cycles_per_write = write_cycles / static_cast<float>(writes);
+            mixed_cycles_per_write = cycles_per_write;
+        }
+        if (verbose)
+            std::cout << std::fixed << std::setprecision(3) << "Steady state -- "
+                      << (s0.t_ns - samples[0].t_ns) / 1e6 << "ms to " << (s1.t_ns - samples[0].t_ns) / 1e6
+                      << "ms (" << window.end - window.begin << " of " << samples.size() - 1 << " samples)"
+                      << std::endl;
+    }
+    else if (verbose)
+        std::cout << "Steady state -- not found, reporting totals" << std::endl;
+
     if (num_readers > 0)
     {
         float tot_read_time = tot_read_cycles / 1e9;
-        const size_t READ_LOOP = RD_INNER_LOOP * RD_OUTER_LOOP;
-        float cycles_per_read = tot_read_cycles / static_cast<float>(readers.size() * READ_LOOP);
         if (verbose)
             std::cout << std::fixed << std::setprecision(3) << "Read -- Avg time: " << tot_read_time / readers.size()
                       << "s | Cycles per read: " << cycles_per_read << std::endl;
@@ -221,13 +668,36 @@ int main(int argc, char **argv)
     if (num_writers > 0)
     {
         float tot_write_time = tot_write_cycles / 1e9;
-        float cycles_per_write = tot_write_cycles / static_cast<float>(writers.size() * NUM_WRITES);
+        float avg_latency = tot_write_latency / static_cast<float>(NUM_WRITES);
         if (verbose)
+        {
             std::cout << std::fixed << std::setprecision(3) << "Write -- Avg time: " << tot_write_time / writers.size()
                       << "s | Cycles per write: " << cycles_per_write << std::endl;
+            std::cout << "Write latency -- Avg: " << avg_latency << "ns | Max: " << max_write_latency << "ns"
+                      << std::endl;
+            std::cout << "Write rate -- Achieved: " << writes_per_sec << " writes/sec";
+            if (write_rate > 0)
+                std::cout << " (target: " << write_rate << ") | Due but never issued: " << NUM_UNISSUED;
+            std::cout << std::endl;
+        }
+        else // extra columns: avg & max write latency (from scheduled time in the open loop), the rcu stats, then
+             // the achieved writes/sec & how many scheduled writes were never issued
+            std::cout << cycles_per_write << " " << avg_latency << " " << max_write_latency << " "
+                      << rcu_stats_columns() << " " << writes_per_sec << " " << NUM_UNISSUED << std::endl;
+    }
+    if (mixers.size() > 0)
+    {
+        // aggregate throughput across all the mixed threads
+        if (verbose)
+            std::cout << std::fixed << std::setprecision(3) << "Mixed -- Throughput: " << mixed_ops_per_sec
+                      << " ops/sec | Cycles per read: " << mixed_cycles_per_read
+                      << " | Cycles per write: " << mixed_cycles_per_write << std::endl;
         else
-            std::cout << cycles_per_write << std::endl;
+            std::cout << mixed_ops_per_sec << " " << mixed_cycles_per_read << " " << mixed_cycles_per_write << " "
+                      << rcu_stats_columns() << std::endl;
     }
+    if (verbose)
+        print_rcu_stats();
 
     finalize_op();
 
@@ -27,6 +27,13 @@ ATOMIC_VEC = "atomic-vec"
 BUMP_COUNTER = "bump-counter"
 STRUCT_ABC = "struct-abc"
 ops = [BUMP_COUNTER, STRUCT_ABC, ATOMIC_STR, ATOMIC_VEC]
+# ops with their own sweeps (not part of the readers x writers grid)
+MULTI_SLOT = "multi-slot"
+BLOB = "blob"
+
+# extra columns of the (quiet) write line
+WRITE_COL_PUBLISH = 4  # RCU copy & publish ns per write (ie. without the grace period)
+WRITE_COL_ACHIEVED = 9  # achieved writes/sec (vs --write-rate)
 
 
 def is_slow(op: str):
@@ -36,17 +43,34 @@ def is_slow(op: str):
 
 
 def run_benchmark(
-    num_readers: int, num_writers: int, mode: str, op: str
+    num_readers: int,
+    num_writers: int,
+    mode: str,
+    op: str,
+    write_rate: float = None,  # open-loop writes/sec (None for the closed loop)
+    loops: Tuple[int, int] = None,  # (outer, inner) read loops to override the defaults
+    extra_args: str = "",  # any other (ie. op-specific) options
+    write_stats: list = None,  # filled with every column of the write line (see the WRITE_COL_* indices)
 ) -> Tuple[float, float]:
     slow: list = (
         [LOCK, RWLOCK] if not is_slow(op) else [ATOMIC, LOCK, RWLOCK]
     )  # atomic is slow
     RD_OUTER_LOOP = 1000 if mode not in slow else 100
     RD_INNER_LOOP = 2000 if mode not in slow else 200
+    if loops is not None:
+        RD_OUTER_LOOP, RD_INNER_LOOP = loops
 
     binary: str = os.path.join(OUT, f"{op}.{BIN_SUFFIX}")
     benchmark_cmd: str = f"{binary} {num_readers} {num_writers} {mode} {RD_OUTER_LOOP} {RD_INNER_LOOP} quiet"
+    if write_rate is not None:
+        benchmark_cmd += f" --write-rate={write_rate}"  # hold the write load constant across modes
+    benchmark_cmd += f" {extra_args}"
     out = os.popen(benchmark_cmd).read()
+    lines = [line.split() for line in out.split("\n") if line.strip()]
+    if write_stats is not None and num_writers > 0 and len(lines) > 0:
+        write_stats[:] = [float(v) for v in lines[-1]]  # the write line is always last
+    # first column of each line is the cycles per op, the rest are extra stats
+    out = "\n".join(line[0] for line in lines) + "\n"
     time_read = None
     time_write = None
     if num_readers == 0 and num_writers == 0:
@@ -392,6 +416,102 @@ def plot_big_cmp(
     plt.close()
 
 
+def blob_crossover_collection(
+    datafile: str,
+    sizes: list = [2**i for i in range(6, 27, 2)],  # 64B to 64MB
+    modes: list = [RCU, RWLOCK, LOCK],
+    num_readers: int = 4,
+    num_writers: int = 1,
+    write_rate: float = 1000,  # same write load for every mode & size
+    duration_ms: int = 1000,  # every point runs this long (ie. ~1000 writes at the target rate)
+    read_inner: int = 10,  # reads between quiescent states, same for every size
+    read_frac: float = 0.1,
+    hugepages: str = "none",
+) -> None:
+    # RCU copy-on-write vs in-place (lock protected) update as the payload grows
+    data = np.full(shape=(len(modes), len(sizes), 2), fill_value=np.nan)
+    publish = np.full(shape=(len(modes), len(sizes)), fill_value=np.nan)
+    achieved = np.full(shape=(len(modes), len(sizes)), fill_value=np.nan)
+    for i, mode in enumerate(modes):
+        for j, size in enumerate(sizes):
+            # fixed duration (not a loop count) so even the fastest sizes see hundreds of writes
+            write_stats = []
+            value = run_benchmark(
+                num_readers=num_readers,
+                num_writers=num_writers,
+                mode=mode,
+                op=BLOB,
+                write_rate=write_rate,
+                loops=(1, read_inner),  # the outer loop count is unused with --duration-ms
+                extra_args=f"--duration-ms={duration_ms} --blob-bytes={size} --read-frac={read_frac} --hugepages={hugepages}",
+                write_stats=write_stats,
+            )
+            data[i, j, :] = [np.nan if v is None else v for v in value]
+            if len(write_stats) > WRITE_COL_ACHIEVED:
+                if mode == RCU:  # the copy cost on its own, since the grace period depends on the readers
+                    publish[i, j] = write_stats[WRITE_COL_PUBLISH]
+                achieved[i, j] = write_stats[WRITE_COL_ACHIEVED]
+                if achieved[i, j] < 0.9 * write_rate:
+                    print(
+                        f"({BLOB} {mode}) Only {achieved[i, j]:.1f} of {write_rate} writes/sec at size {size}B"
+                    )
+            print(f"({BLOB} {mode}) Done size {size}B", end="\r", flush=True)
+    print()
+    np.savez(
+        datafile,
+        data=data,
+        publish=publish,
+        achieved=achieved,
+        sizes=np.array(sizes),
+        modes=np.array(modes),
+    )
+
+
+def plot_blob_crossover(
+    datafile: str, hugepages: str, y_scale=lambda x: np.log10(x)
+) -> None:
+    saved = np.load(datafile)
+    data, sizes, modes = saved["data"], saved["sizes"], list(saved["modes"])
+    publish = saved["publish"]
+    x_axis = np.log2(sizes)
+    for idx, op_type in enumerate(("Read", "Write")):
+        fig, ax = plt.subplots(1, 1)
+        ax_plots = []  # for the legends
+        for i, mode in enumerate(modes):
+            cycle_time = data[i, :, idx]
+            (ax_plot,) = ax.plot(
+                x_axis[np.isfinite(cycle_time)],
+                y_scale(cycle_time[np.isfinite(cycle_time)]),  # ignore plotting None's
+                linewidth=3,
+                label=f"{mode}",
+            )
+            ax_plots.append(ax_plot)
+            if op_type == "Write" and mode == RCU:  # copy cost without the (reader dependent) grace period
+                copy_time = publish[i, :]
+                (ax_plot,) = ax.plot(
+                    x_axis[np.isfinite(copy_time)],
+                    y_scale(copy_time[np.isfinite(copy_time)]),
+                    linewidth=3,
+                    linestyle="--",
+                    color=ax_plot.get_color(),
+                    label=f"{mode} (copy & publish)",
+                )
+                ax_plots.append(ax_plot)
+        ax.legend(handles=ax_plots)
+        ax.set_ylabel("(log10) CPU Cycles (log(ns))")
+        ax.set_xlabel("(log2) Payload size (bytes)")
+        plt.title(
+            f"(log10) Cycles per {op_type} by payload size ({hugepages} huge pages)"
+        )
+        plt.tight_layout()
+        filepath: str = os.path.join(
+            os.path.dirname(datafile), f"crossover_{op_type.lower()}_{hugepages}.png"
+        )
+        print(f"saving figure to {filepath}")
+        fig.savefig(filepath)
+        plt.close()
+
+
 def data_analysis(working_dir: str):
     np_files = glob.glob(os.path.join(working_dir, "*.npy"))
     if len(np_files) != 1:
@@ -435,8 +555,20 @@ if __name__ == "__main__":
 
     for binary in glob.glob(os.path.join(OUT, f"*.{BIN_SUFFIX}")):
         op = os.path.basename(binary).replace(".out", "")
+        if op not in ops:
+            continue  # has its own analysis (ie. the blob crossover below)
         working_dir: str = os.path.join(results, op)
         os.makedirs(working_dir, exist_ok=True)
         datafile = os.path.join(working_dir, "data.npy")
         # data_collection(datafile, op)
         data_analysis(working_dir)
+
+    # RCU copy-on-write vs in-place update crossover (collected once, since the sweep is slow)
+    if os.path.exists(os.path.join(OUT, f"{BLOB}.{BIN_SUFFIX}")):
+        working_dir: str = os.path.join(results, BLOB)
+        os.makedirs(working_dir, exist_ok=True)
+        for hugepages in ["none", "thp"]:
+            datafile = os.path.join(working_dir, f"crossover_{hugepages}.npz")
+            if not os.path.exists(datafile) or "publish" not in np.load(datafile):
+                blob_crossover_collection(datafile, hugepages=hugepages)
+            plot_blob_crossover(datafile, hugepages=hugepages)
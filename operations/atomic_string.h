@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../rcu_stats.h"
 #include "../sync_modes.h"
 #include "../utils.h"
 #include <ctime>   // std::time
@@ -20,6 +21,16 @@ inline void write_str(data_t &out)
     out = oss.str();
 }
 
+inline bool parse_op_flag(const std::string &arg)
+{
+    return false; // no op-specific options
+}
+
+inline void init_op()
+{
+    // nothing to do
+}
+
 inline void write_op()
 {
     switch (sync_method)
@@ -29,6 +40,7 @@ inline void write_op()
         // https://www.kernel.org/doc/html/latest/RCU/whatisRCU.html#what-are-some-example-uses-of-core-rcu-api
         data_t *new_counter;
         data_t *old_counter;
+        auto t0_ns = get_cycles();
         new_counter = new data_t{};
         pthread_mutex_lock(&mutexlock);
         old_counter = gbl_data;                                 // copy ptr of global
@@ -36,8 +48,7 @@ inline void write_op()
         write_str(*new_counter);                                // perform write
         old_counter = rcu_xchg_pointer(&gbl_data, new_counter); // swap with global
         pthread_mutex_unlock(&mutexlock);
-        synchronize_rcu(); // synchronize_rcu();
-        delete old_counter;
+        rcu_publish_and_reclaim(old_counter, t0_ns, [](data_t *old) { delete old; });
         break;
     }
     case (SyncMethod::ATOMIC): // no atomic string
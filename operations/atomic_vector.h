@@ -1,10 +1,13 @@
 #pragma once
 
+#include "../rcu_stats.h"
 #include "../sync_modes.h"
 #include "../utils.h"
+#include <cassert> // assert
 #include <ctime>   // std::time
 #include <iomanip> // std::setprecision, std::put_time
 #include <iostream>
+#include <string>
 #include <sstream> // std::ostringstream
 #include <vector>
 
@@ -15,7 +18,7 @@ data_t *gbl_data = new data_t(100, 0); // this is the global! (100 zeros)
 inline void write_vector(data_t &out)
 {
     assert(out.size() > 0);
-    int idx = std::rand() % out.size();
+    int idx = fast_rand() % out.size();
     out[idx]++;                                                            // increment some random index
     if (idx > static_cast<int>(0.9f * out.size()) && out.size() < MAX_LEN) // int the last 10%
     {
@@ -23,6 +26,16 @@ inline void write_vector(data_t &out)
     }
 }
 
+inline bool parse_op_flag(const std::string &arg)
+{
+    return false; // no op-specific options
+}
+
+inline void init_op()
+{
+    // nothing to do
+}
+
 inline void write_op()
 {
     switch (sync_method)
@@ -32,6 +45,7 @@ inline void write_op()
         // https://www.kernel.org/doc/html/latest/RCU/whatisRCU.html#what-are-some-example-uses-of-core-rcu-api
         data_t *new_counter;
         data_t *old_counter;
+        auto t0_ns = get_cycles();
         new_counter = new data_t{};
         pthread_mutex_lock(&mutexlock);
         old_counter = gbl_data;                                 // copy ptr of global
@@ -39,8 +53,7 @@ inline void write_op()
         write_vector(*new_counter);                             // perform write
         old_counter = rcu_xchg_pointer(&gbl_data, new_counter); // swap with global
         pthread_mutex_unlock(&mutexlock);
-        synchronize_rcu(); // synchronize_rcu();
-        delete old_counter;
+        rcu_publish_and_reclaim(old_counter, t0_ns, [](data_t *old) { delete old; });
         break;
     }
     case (SyncMethod::ATOMIC): // no atomic vector, just uses a lock internally
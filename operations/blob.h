@@ -0,0 +1,297 @@
+#pragma once
+
+#include "../rcu_stats.h"
+#include "../sync_modes.h"
+#include "../utils.h"
+#include <algorithm> // std::min, std::max
+#include <cstdint>   // uintptr_t
+#include <cstdlib>   // aligned_alloc, exit
+#include <cstring>   // std::memcpy, std::memset
+#include <iostream>
+#include <string>
+#include <sys/mman.h> // mmap, madvise
+
+// one large payload to find where RCU's full copy per write stops paying off
+struct data_t
+{
+    uint8_t *bytes = nullptr;
+    size_t size = 0;
+};
+
+enum HugePages : uint8_t
+{
+    NONE = 0, // regular (aligned) heap allocations
+    THP,      // anonymous mmap + madvise(MADV_HUGEPAGE) for transparent huge pages
+    EXPLICIT, // mmap(MAP_HUGETLB) from the reserved huge page pool
+};
+
+size_t blob_bytes = 4096;              // set by --blob-bytes (accepts K/M/G suffixes)
+double read_frac = 1.0;                // set by --read-frac (fraction of the blob each read checksums)
+size_t patch_bytes = 64;               // set by --patch-bytes (region each write overwrites)
+HugePages hugepages = HugePages::NONE; // set by --hugepages
+
+const size_t BLOB_ALIGN = 64;                   // cache line (and the checksum's stride)
+const size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024; // 2MB huge pages
+
+data_t *gbl_data = nullptr; // this is the global! (allocated in init_op once the size is known)
+
+inline size_t parse_bytes(const std::string &value)
+{
+    size_t pos = 0;
+    double num = std::stod(value, &pos);
+    const std::string suffix = value.substr(pos);
+    if (suffix == "K" || suffix == "k")
+        num *= 1024;
+    else if (suffix == "M" || suffix == "m")
+        num *= 1024 * 1024;
+    else if (suffix == "G" || suffix == "g")
+        num *= 1024 * 1024 * 1024;
+    else if (!suffix.empty())
+        throw std::runtime_error("unable to interpret size \"" + value + "\"");
+    return static_cast<size_t>(num);
+}
+
+inline bool parse_op_flag(const std::string &arg)
+{
+    std::string value;
+    if (match_flag(arg, "blob-bytes", value))
+        blob_bytes = std::max(parse_bytes(value), static_cast<size_t>(1));
+    else if (match_flag(arg, "read-frac", value))
+        read_frac = std::min(std::max(std::atof(value.c_str()), 0.0), 1.0);
+    else if (match_flag(arg, "patch-bytes", value))
+        patch_bytes = std::max(parse_bytes(value), static_cast<size_t>(1));
+    else if (match_flag(arg, "hugepages", value))
+    {
+        if (value == "none")
+            hugepages = HugePages::NONE;
+        else if (value == "thp")
+            hugepages = HugePages::THP;
+        else if (value == "explicit")
+            hugepages = HugePages::EXPLICIT;
+        else
+            throw std::runtime_error("unable to interpret hugepages \"" + value + "\"");
+    }
+    else
+        return false;
+    return true;
+}
+
+inline size_t round_up(size_t n, size_t align)
+{
+    return ((n + align - 1) / align) * align;
+}
+
+inline HugePages backing() // blobs smaller than a huge page would only pay for an mmap, munmap & faults per write
+{
+    return (blob_bytes < HUGE_PAGE_BYTES) ? HugePages::NONE : hugepages;
+}
+
+inline size_t alloc_size()
+{
+    return round_up(blob_bytes, (backing() == HugePages::NONE) ? BLOB_ALIGN : HUGE_PAGE_BYTES);
+}
+
+// (RCU) writers allocate every new version from their own threads, where an exception would just std::terminate
+inline void alloc_failed(size_t len, const char *hint)
+{
+    std::cerr << "Unable to allocate a blob of " << len << " bytes" << hint << std::endl;
+    exit(1);
+}
+
+inline uint8_t *alloc_bytes()
+{
+    const size_t len = alloc_size();
+    if (backing() == HugePages::NONE)
+    {
+        void *ptr = aligned_alloc(BLOB_ALIGN, len);
+        if (ptr == nullptr)
+            alloc_failed(len, "");
+        return static_cast<uint8_t *>(ptr);
+    }
+#if defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+    if (backing() == HugePages::EXPLICIT) // hugetlb mappings are always huge page aligned
+    {
+        void *ptr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr == MAP_FAILED) // every RCU writer holds an old & a new version, so the pool needs room for both
+            alloc_failed(len, " from the huge page pool (RCU needs 2 blobs per writer, see /proc/sys/vm/nr_hugepages)");
+        return static_cast<uint8_t *>(ptr);
+    }
+    // over-map by a huge page then trim both ends, so the blob starts on a boundary THP can actually back
+    void *raw = mmap(nullptr, len + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        alloc_failed(len, "");
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = round_up(start, HUGE_PAGE_BYTES);
+    if (aligned > start)
+        munmap(raw, aligned - start); // head
+    if (aligned - start < HUGE_PAGE_BYTES)
+        munmap(reinterpret_cast<void *>(aligned + len), HUGE_PAGE_BYTES - (aligned - start)); // tail
+    uint8_t *ptr = reinterpret_cast<uint8_t *>(aligned);
+    madvise(ptr, len, MADV_HUGEPAGE); // only a hint, fine if THP is disabled
+    return ptr;
+#else
+    throw std::runtime_error("huge pages are not supported on this platform");
+#endif
+}
+
+inline void free_bytes(uint8_t *bytes)
+{
+    if (backing() == HugePages::NONE)
+        free(bytes);
+    else
+        munmap(bytes, alloc_size());
+}
+
+inline data_t *new_blob()
+{
+    data_t *blob = new data_t{};
+    blob->bytes = alloc_bytes();
+    blob->size = blob_bytes;
+    return blob;
+}
+
+inline void delete_blob(data_t *blob)
+{
+    free_bytes(blob->bytes);
+    delete blob;
+}
+
+inline void init_op()
+{
+    gbl_data = new_blob();
+    for (size_t i = 0; i < gbl_data->size; i++)
+        gbl_data->bytes[i] = static_cast<uint8_t>(i * 31); // touch every page up front
+    patch_bytes = std::min(patch_bytes, blob_bytes);
+
+    if (verbose)
+        std::cout << "Using a " << blob_bytes << " byte blob (" << read_frac * 100 << "% checksummed per read, "
+                  << patch_bytes << " bytes patched per write, "
+                  << (backing() == HugePages::NONE ? "no" : (backing() == HugePages::THP ? "transparent" : "explicit"))
+                  << " huge pages)" << std::endl;
+}
+
+// sum of 64-bit words using (portable clang/gcc) vector extensions, 2 independent accumulators per 64 bytes
+typedef uint64_t u64x4 __attribute__((vector_size(32)));
+inline uint64_t checksum(const uint8_t *bytes, size_t len)
+{
+    u64x4 acc0 = {0, 0, 0, 0};
+    u64x4 acc1 = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64)
+    {
+        u64x4 lo;
+        u64x4 hi;
+        std::memcpy(&lo, bytes + i, sizeof(lo)); // (unaligned) vector loads
+        std::memcpy(&hi, bytes + i + 32, sizeof(hi));
+        acc0 += lo;
+        acc1 += hi;
+    }
+    acc0 += acc1;
+    uint64_t sum = acc0[0] + acc0[1] + acc0[2] + acc0[3];
+    for (; i < len; i++) // leftover tail bytes
+        sum += bytes[i];
+    return sum;
+}
+
+inline uint64_t read_blob(const data_t &blob)
+{
+    // checksum a read_frac sized window at a random (cache line aligned) offset
+    const size_t len = std::min(round_up(static_cast<size_t>(read_frac * blob.size), BLOB_ALIGN), blob.size);
+    const size_t slack = (blob.size - len) / BLOB_ALIGN;
+    const size_t offset = (slack > 0) ? (fast_rand() % (slack + 1)) * BLOB_ALIGN : 0;
+    return checksum(blob.bytes + offset, len);
+}
+
+inline void write_blob(data_t &blob)
+{
+    const size_t offset = fast_rand() % (blob.size - patch_bytes + 1);
+    std::memset(blob.bytes + offset, static_cast<uint8_t>(fast_rand()), patch_bytes);
+}
+
+inline void write_op()
+{
+    switch (sync_method)
+    {
+    case (SyncMethod::RCU): {
+        // similar to
+        // https://www.kernel.org/doc/html/latest/RCU/whatisRCU.html#what-are-some-example-uses-of-core-rcu-api
+        data_t *new_blob_ptr;
+        data_t *old_blob_ptr;
+        auto t0_ns = get_cycles();
+        new_blob_ptr = new_blob();
+        pthread_mutex_lock(&mutexlock);
+        old_blob_ptr = gbl_data;                                                   // copy ptr of global
+        std::memcpy(new_blob_ptr->bytes, old_blob_ptr->bytes, old_blob_ptr->size); // full copy of the old blob
+        write_blob(*new_blob_ptr);                                                 // perform write
+        old_blob_ptr = rcu_xchg_pointer(&gbl_data, new_blob_ptr);                  // swap with global
+        pthread_mutex_unlock(&mutexlock);
+        rcu_publish_and_reclaim(old_blob_ptr, t0_ns, delete_blob);
+        break;
+    }
+    case (SyncMethod::ATOMIC): // no atomic blob, just uses a lock internally
+    case (SyncMethod::RWLOCK): {
+        pthread_rwlock_wrlock(&rwlock); // lock for writing
+        write_blob(*gbl_data);          // patch in place
+        pthread_rwlock_unlock(&rwlock);
+        break;
+    }
+    case (SyncMethod::LOCK): {
+        pthread_mutex_lock(&mutexlock); // lock for writing
+        write_blob(*gbl_data);          // patch in place
+        pthread_mutex_unlock(&mutexlock);
+        break;
+    }
+    case (SyncMethod::RACE): {
+        write_blob(*gbl_data);
+        break;
+    }
+    default:
+        throw std::runtime_error("Not implemented!");
+    }
+}
+
+inline uint64_t read_op()
+{
+    uint64_t val = 0;
+    switch (sync_method)
+    {
+    case (SyncMethod::RCU): {
+        _rcu_read_lock();
+        data_t *local_ptr = nullptr;
+        local_ptr = _rcu_dereference(gbl_data);
+        if (local_ptr)
+            val = read_blob(*local_ptr);
+        _rcu_read_unlock();
+        break;
+    }
+    case (SyncMethod::ATOMIC):
+    case (SyncMethod::RWLOCK): {
+        pthread_rwlock_rdlock(&rwlock); // lock for reading
+        val = read_blob(*gbl_data);
+        pthread_rwlock_unlock(&rwlock);
+        break;
+    }
+    case (SyncMethod::LOCK): {
+        pthread_mutex_lock(&mutexlock); // lock for reading
+        val = read_blob(*gbl_data);
+        pthread_mutex_unlock(&mutexlock);
+        break;
+    }
+    case (SyncMethod::RACE): {
+        val = read_blob(*gbl_data);
+        break;
+    }
+    default:
+        throw std::runtime_error("Not implemented!");
+    }
+    do_not_optimize(val); // the checksum is the whole point of the read
+    return val;
+}
+
+inline void finalize_op()
+{
+    const uint64_t sum = checksum(gbl_data->bytes, gbl_data->size);
+    if (verbose)
+        std::cout << "Final data len: " << gbl_data->size << " & checksum: " << sum << std::endl;
+    delete_blob(gbl_data);
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "../rcu_stats.h"
+#include "../sync_modes.h"
+#include "../utils.h"
+#include <algorithm> // std::max
+#include <atomic>    // std::atomic
+#include <iostream>
+#include <string>
+#include <vector> // std::vector
+
+typedef size_t data_t;
+
+// many independently protected objects (bump counters) instead of one gbl_data
+struct alignas(64) slot_t // own cache line so neighbouring slots don't false-share
+{
+    data_t *data = nullptr;             // RCU/locks protected pointer
+    std::atomic<data_t> data_atomic{0}; // used in ATOMIC mode
+};
+
+struct alignas(64) stripe_t // lock stripe protecting every slot (i % num_stripes)
+{
+    pthread_rwlock_t rwlock;
+    pthread_mutex_t mutexlock;
+};
+
+size_t num_slots = 1024; // set by --slots
+size_t num_stripes = 0;  // set by --stripes (0 => one lock stripe per slot)
+double zipf_theta = 0;   // set by --zipf (0 => uniform slot accesses)
+size_t rcu_batch = 1;    // set by --rcu-batch (slot updates per synchronize_rcu(), 1 => one grace period per write)
+
+slot_t *slots = nullptr;
+stripe_t *stripes = nullptr;
+ZipfGenerator *slot_dist = nullptr; // only when zipf_theta > 0
+
+// old slot versions this thread has unpublished but not yet reclaimed (batched RCU writes)
+struct RetiredCounters
+{
+    RetiredCounters()
+    {
+        (void)rcu_thread_stats; // construct the stats first so they are destroyed after the final reclaim below
+    }
+    ~RetiredCounters()
+    {
+        reclaim(); // whatever is left as the thread exits
+    }
+    std::vector<data_t *> versions;
+
+    inline void reclaim()
+    {
+        rcu_reclaim_batch(versions, [](data_t *old) { delete old; });
+    }
+};
+thread_local RetiredCounters retired_counters;
+
+inline bool parse_op_flag(const std::string &arg)
+{
+    std::string value;
+    if (match_flag(arg, "slots", value))
+        num_slots = std::max(std::atoi(value.c_str()), 1);
+    else if (match_flag(arg, "stripes", value))
+        num_stripes = std::atoi(value.c_str());
+    else if (match_flag(arg, "zipf", value))
+        zipf_theta = std::atof(value.c_str());
+    else if (match_flag(arg, "rcu-batch", value))
+        rcu_batch = std::max(std::atoi(value.c_str()), 1);
+    else
+        return false;
+    return true;
+}
+
+inline void init_op()
+{
+    if (zipf_theta < 0 || zipf_theta >= 1)
+        throw std::runtime_error("zipf theta must be in [0, 1)");
+    if (num_stripes == 0 || num_stripes > num_slots)
+        num_stripes = num_slots;
+
+    slots = new slot_t[num_slots];
+    for (size_t i = 0; i < num_slots; i++)
+        slots[i].data = new data_t(0);
+
+    stripes = new stripe_t[num_stripes];
+    for (size_t i = 0; i < num_stripes; i++)
+    {
+        pthread_rwlock_init(&stripes[i].rwlock, NULL);
+        pthread_mutex_init(&stripes[i].mutexlock, NULL);
+    }
+
+    if (zipf_theta > 0)
+        slot_dist = new ZipfGenerator(num_slots, zipf_theta);
+
+    if (verbose)
+        std::cout << "Using " << num_slots << " slots over " << num_stripes << " lock stripes with "
+                  << (zipf_theta > 0 ? "zipf(" + std::to_string(zipf_theta) + ")" : "uniform") << " accesses & "
+                  << rcu_batch << " RCU update(s) per grace period" << std::endl;
+}
+
+inline size_t pick_slot()
+{
+    return slot_dist ? slot_dist->next() : fast_rand() % num_slots;
+}
+
+inline stripe_t &stripe_of(size_t slot)
+{
+    return stripes[slot % num_stripes];
+}
+
+inline void write_op()
+{
+    const size_t i = pick_slot();
+    slot_t &slot = slots[i];
+    stripe_t &stripe = stripe_of(i);
+    switch (sync_method)
+    {
+    case (SyncMethod::RCU): {
+        // same as bump_counter but the writer-side mutex is per (stripe of) slot. synchronize_rcu() still waits for
+        // a global grace period, so --rcu-batch shares one across many slot updates instead
+        data_t *new_counter;
+        data_t *old_counter;
+        auto t0_ns = get_cycles();
+        new_counter = new data_t{0};
+        pthread_mutex_lock(&stripe.mutexlock);
+        old_counter = slot.data;                                 // copy ptr of the slot
+        *new_counter = (*old_counter + 1);                       // bump slot's value to local new
+        old_counter = rcu_xchg_pointer(&slot.data, new_counter); // swap with the slot
+        pthread_mutex_unlock(&stripe.mutexlock);
+        if (rcu_batch <= 1)
+            rcu_publish_and_reclaim(old_counter, t0_ns, [](data_t *old) { delete old; });
+        else
+        { // defer the reclaim until rcu_batch old versions wait on the same grace period
+            rcu_retire_version();
+            rcu_record_publish(get_cycles() - t0_ns);
+            retired_counters.versions.push_back(old_counter);
+            if (retired_counters.versions.size() >= rcu_batch)
+                retired_counters.reclaim();
+        }
+        break;
+    }
+    case (SyncMethod::ATOMIC): {
+        slot.data_atomic++; // bump
+        break;
+    }
+    case (SyncMethod::RWLOCK): {
+        pthread_rwlock_wrlock(&stripe.rwlock); // lock for writing
+        (*slot.data)++;                        // bump
+        pthread_rwlock_unlock(&stripe.rwlock);
+        break;
+    }
+    case (SyncMethod::LOCK): {
+        pthread_mutex_lock(&stripe.mutexlock); // lock for writing
+        (*slot.data)++;                        // bump
+        pthread_mutex_unlock(&stripe.mutexlock);
+        break;
+    }
+    case (SyncMethod::RACE): {
+        (*slot.data)++; // bump
+        break;
+    }
+    default:
+        throw std::runtime_error("Not implemented!");
+    }
+}
+
+inline data_t read_op()
+{
+    const size_t i = pick_slot();
+    slot_t &slot = slots[i];
+    stripe_t &stripe = stripe_of(i);
+    data_t val = 0;
+    switch (sync_method)
+    {
+    case (SyncMethod::RCU): {
+        _rcu_read_lock();
+        data_t *local_ptr = nullptr;
+        local_ptr = _rcu_dereference(slot.data);
+        if (local_ptr)
+            val = (*local_ptr);
+        _rcu_read_unlock();
+        break;
+    }
+    case (SyncMethod::ATOMIC): {
+        val = slot.data_atomic.load();
+        break;
+    }
+    case (SyncMethod::RWLOCK): {
+        pthread_rwlock_rdlock(&stripe.rwlock); // lock for reading
+        val = (*slot.data);
+        pthread_rwlock_unlock(&stripe.rwlock);
+        break;
+    }
+    case (SyncMethod::LOCK): {
+        pthread_mutex_lock(&stripe.mutexlock); // lock for reading
+        val = (*slot.data);
+        pthread_mutex_unlock(&stripe.mutexlock);
+        break;
+    }
+    case (SyncMethod::RACE): {
+        val = (*slot.data);
+        break;
+    }
+    default:
+        throw std::runtime_error("Not implemented!");
+    }
+    return val;
+}
+
+inline void finalize_op()
+{
+    data_t final_data = 0; // total bumps across all the slots
+    data_t hottest = 0;
+    for (size_t i = 0; i < num_slots; i++)
+    {
+        data_t val = (sync_method == SyncMethod::ATOMIC) ? slots[i].data_atomic.load() : *slots[i].data;
+        final_data += val;
+        hottest = std::max(hottest, val);
+        delete slots[i].data;
+    }
+
+    if (verbose)
+        std::cout << "Final data: " << final_data << " over " << num_slots << " slots (hottest: " << hottest << ")"
+                  << std::endl;
+
+    for (size_t i = 0; i < num_stripes; i++)
+    {
+        pthread_rwlock_destroy(&stripes[i].rwlock);
+        pthread_mutex_destroy(&stripes[i].mutexlock);
+    }
+    delete[] stripes;
+    delete[] slots;
+    delete slot_dist;
+}
@@ -1,9 +1,11 @@
 #pragma once
 
+#include "../rcu_stats.h"
 #include "../sync_modes.h"
 #include "../utils.h"
 #include <iomanip> // std::setprecision
 #include <iostream>
+#include <string>
 
 struct data_t
 {
@@ -25,6 +27,16 @@ struct data_t
 
 data_t *gbl_data = new data_t(0, 0, 0); // this is the global!
 
+inline bool parse_op_flag(const std::string &arg)
+{
+    return false; // no op-specific options
+}
+
+inline void init_op()
+{
+    // nothing to do
+}
+
 inline void write_op()
 {
     switch (sync_method)
@@ -34,6 +46,7 @@ inline void write_op()
         // https://www.kernel.org/doc/html/latest/RCU/whatisRCU.html#what-are-some-example-uses-of-core-rcu-api
         data_t *new_counter;
         data_t *old_counter;
+        auto t0_ns = get_cycles();
         new_counter = new data_t{};
         pthread_mutex_lock(&mutexlock);
         old_counter = gbl_data;        // copy ptr of global
@@ -43,8 +56,7 @@ inline void write_op()
         }
         old_counter = rcu_xchg_pointer(&gbl_data, new_counter); // swap with global
         pthread_mutex_unlock(&mutexlock);
-        synchronize_rcu(); // synchronize_rcu();
-        delete old_counter;
+        rcu_publish_and_reclaim(old_counter, t0_ns, [](data_t *old) { delete old; });
         break;
     }
     case (SyncMethod::ATOMIC): // implement "atomic" as using locks
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "utils.h"        // cycles_t
+#include <algorithm>      // std::max
+#include <atomic>         // std::atomic
+#include <pthread.h>      // pthread_mutex_t
+#include <sys/resource.h> // getrusage
+#include <vector>         // std::vector
+
+// instrumentation of the RCU write paths: grace periods & how long old versions stay alive
+struct RcuStats
+{
+    size_t grace_periods = 0;    // number of synchronize_rcu() calls
+    cycles_t grace_cycles = 0;   // time spent blocked in synchronize_rcu()
+    size_t publishes = 0;        // number of new versions published (ie. writes)
+    cycles_t publish_cycles = 0; // time spent allocating, copying, updating & publishing
+    size_t max_old_versions = 0; // most unpublished versions alive at once
+    size_t old_versions_sum = 0; // old versions alive sampled on every retire (for the average)
+
+    inline void merge(const RcuStats &other)
+    {
+        grace_periods += other.grace_periods;
+        grace_cycles += other.grace_cycles;
+        publishes += other.publishes;
+        publish_cycles += other.publish_cycles;
+        max_old_versions = std::max(max_old_versions, other.max_old_versions);
+        old_versions_sum += other.old_versions_sum;
+    }
+};
+RcuStats rcu_stats; // totals over all the threads that have exited
+pthread_mutex_t rcu_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// every thread accumulates its own stats (so writers don't contend on them) & merges them in as it exits
+struct RcuThreadStats : RcuStats
+{
+    ~RcuThreadStats()
+    {
+        pthread_mutex_lock(&rcu_stats_lock);
+        rcu_stats.merge(*this);
+        pthread_mutex_unlock(&rcu_stats_lock);
+    }
+};
+thread_local RcuThreadStats rcu_thread_stats;
+
+// the only counter that has to be shared: unpublished versions not yet reclaimed right now (own cache line)
+struct alignas(64) RcuOldVersions
+{
+    std::atomic<size_t> alive{0};
+};
+RcuOldVersions rcu_old_versions;
+
+inline void rcu_retire_version() // call once the old version is unpublished (swapped out)
+{
+    const size_t alive = rcu_old_versions.alive.fetch_add(1) + 1;
+    rcu_thread_stats.old_versions_sum += alive;
+    rcu_thread_stats.max_old_versions = std::max(rcu_thread_stats.max_old_versions, alive);
+}
+
+inline void rcu_reclaim_version() // call once the old version is freed
+{
+    rcu_old_versions.alive--;
+}
+
+inline void rcu_record_publish(cycles_t publish_cycles)
+{
+    rcu_thread_stats.publishes++;
+    rcu_thread_stats.publish_cycles += publish_cycles;
+}
+
+inline void rcu_record_grace_period(cycles_t grace_cycles)
+{
+    rcu_thread_stats.grace_periods++;
+    rcu_thread_stats.grace_cycles += grace_cycles;
+}
+
+inline void rcu_record_write(cycles_t publish_cycles, cycles_t grace_cycles)
+{
+    rcu_record_publish(publish_cycles);
+    rcu_record_grace_period(grace_cycles);
+}
+
+// the end of every op's RCU write: retire the (already unpublished) old version, wait out a grace period, then
+// reclaim it with the deleter. t0_ns is when the write started so allocating, copying & publishing is timed too
+template <typename T, typename Deleter>
+inline void rcu_publish_and_reclaim(T *old_version, cycles_t t0_ns, Deleter deleter)
+{
+    rcu_retire_version();
+    const cycles_t t1_ns = get_cycles();
+    synchronize_rcu(); // blocks until every reader has passed a quiescent state (timed as the grace period)
+    const cycles_t t2_ns = get_cycles();
+    deleter(old_version);
+    rcu_reclaim_version();
+    rcu_record_write(t1_ns - t0_ns, t2_ns - t1_ns); // copy & publish vs grace period
+}
+
+// batched variant: wait out a single grace period for a whole batch of (already retired) old versions, then reclaim
+// them all, amortizing the synchronize_rcu() over every update in the batch
+template <typename T, typename Deleter>
+inline void rcu_reclaim_batch(std::vector<T *> &old_versions, Deleter deleter)
+{
+    if (old_versions.empty())
+        return;
+    const cycles_t t1_ns = get_cycles();
+    synchronize_rcu(); // one grace period covers the whole batch
+    const cycles_t t2_ns = get_cycles();
+    for (T *old_version : old_versions)
+    {
+        deleter(old_version);
+        rcu_reclaim_version();
+    }
+    old_versions.clear();
+    rcu_record_grace_period(t2_ns - t1_ns);
+}
+
+inline long peak_rss_kb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024; // MacOS reports bytes
+#else
+    return usage.ru_maxrss; // Linux reports kilobytes
+#endif
+}
@@ -1,7 +1,12 @@
 #pragma once
 
 #include "sync_modes.h" // SyncMode enum
+#include <atomic>       // std::atomic
+#include <cerrno>       // EINTR
+#include <cmath>        // std::pow
+#include <ctime>        // clock_gettime, clock_nanosleep
 #include <iostream>
+#include <string>
 
 bool verbose = true; // disable with 4th optional param
 
@@ -25,3 +30,126 @@ static inline cycles_t get_cycles()
     // assuming nanoseconds ~ cycles (approximately true)
     return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
 }
+
+// keep the compiler from dropping a (pure) computation whose result is otherwise unused
+template <typename T> static inline void do_not_optimize(const T &val)
+{
+    asm volatile("" : : "r,m"(val) : "memory");
+}
+
+// sleep until the (absolute, CLOCK_MONOTONIC) deadline then spin for the last spin_ns to not oversleep
+static inline void wait_until(cycles_t deadline_ns, cycles_t spin_ns)
+{
+    const cycles_t now_ns = get_cycles();
+    if (deadline_ns > now_ns + spin_ns)
+    {
+        const cycles_t wake_ns = deadline_ns - spin_ns;
+#if defined(__linux__)
+        struct timespec ts;
+        ts.tv_sec = wake_ns / 1000000000ULL;
+        ts.tv_nsec = wake_ns % 1000000000ULL;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+            ; // interrupted by a signal, go back to sleep
+#else // MacOS has no clock_nanosleep, use a relative sleep instead
+        const cycles_t delta_ns = wake_ns - now_ns;
+        struct timespec ts;
+        ts.tv_sec = delta_ns / 1000000000ULL;
+        ts.tv_nsec = delta_ns % 1000000000ULL;
+        nanosleep(&ts, NULL);
+#endif
+    }
+    while (get_cycles() < deadline_ns)
+        ; // timed spin until the deadline
+}
+
+// match cmd options of the form "--name=value", writing the value on success
+inline bool match_flag(const std::string &arg, const std::string &name, std::string &value)
+{
+    const std::string prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0)
+        return false;
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+// counter only ever written by its own thread but sampled by others, so a relaxed load & store is enough (no locked
+// read-modify-write on the hot path)
+struct SampledCounter
+{
+    std::atomic<uint64_t> val{0};
+
+    inline uint64_t load() const
+    {
+        return val.load(std::memory_order_relaxed);
+    }
+    inline operator uint64_t() const
+    {
+        return load();
+    }
+    inline SampledCounter &operator=(uint64_t x)
+    {
+        val.store(x, std::memory_order_relaxed);
+        return *this;
+    }
+    inline SampledCounter &operator+=(uint64_t x)
+    {
+        return (*this = load() + x);
+    }
+    inline void operator++(int)
+    {
+        *this += 1;
+    }
+};
+
+// fast per-thread PRNG (xorshift64*) to not contend on the global state behind std::rand()
+inline uint64_t fast_rand()
+{
+    static std::atomic<uint64_t> seeds{0x9E3779B97F4A7C15ULL}; // distinct seed for every thread
+    thread_local uint64_t state = 0;
+    if (state == 0) // first use on this thread
+        state = (seeds.fetch_add(0x9E3779B97F4A7C15ULL) * 0xBF58476D1CE4E5B9ULL) | 1;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+// uniform double in [0, 1) from the top 53 bits of fast_rand()
+inline double fast_rand_unit()
+{
+    return (fast_rand() >> 11) * (1.0 / (1ULL << 53));
+}
+
+// zipfian draws over [0, n) where index 0 is the hottest (skew 0 < theta < 1)
+// from Gray et al. "Quickly Generating Billion-Record Synthetic Databases" (as used by YCSB)
+struct ZipfGenerator
+{
+    ZipfGenerator(size_t _n, double _theta) : n(_n), theta(_theta)
+    {
+        double zetan = 0;
+        for (size_t i = 1; i <= n; i++)
+            zetan += 1.0 / std::pow(static_cast<double>(i), theta);
+        zeta_n = zetan;
+        half_pow_theta = std::pow(0.5, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - (1.0 + half_pow_theta) / zeta_n);
+    }
+    size_t n;
+    double theta;
+    double zeta_n;
+    double half_pow_theta;
+    double alpha;
+    double eta;
+
+    inline size_t next() const
+    {
+        const double u = fast_rand_unit();
+        const double uz = u * zeta_n;
+        if (uz < 1.0)
+            return 0;
+        if (uz < 1.0 + half_pow_theta)
+            return 1;
+        const size_t idx = static_cast<size_t>(n * std::pow(eta * u - eta + 1.0, alpha));
+        return (idx < n) ? idx : n - 1;
+    }
+};